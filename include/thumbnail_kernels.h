@@ -0,0 +1,166 @@
+/**
+ * @file thumbnail_kernels.h
+ * @brief Wyspecjalizowane jądra skalowania miniatur filtrem powierzchniowym.
+ *
+ * Używane przez pos_projekt oraz przez pos_check_thumbnail_kernel, który porównuje
+ * je z cv::resize(..., INTER_AREA).
+ */
+
+#ifndef THUMBNAIL_KERNELS_H
+#define THUMBNAIL_KERNELS_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Wyznacza położenie obrazu w kwadratowej miniaturze z zachowaniem proporcji.
+ * @param w Szerokość oryginalnego obrazu.
+ * @param h Wysokość oryginalnego obrazu.
+ * @param thumb_size Rozmiar boku miniatury.
+ * @return Prostokąt zajmowany przez obraz, wyśrodkowany w miniaturze.
+ */
+inline cv::Rect thumbnail_roi(int w, int h, int thumb_size) {
+    float scale = thumb_size / static_cast<float>(std::max(w, h));
+    int nw = std::max(1, static_cast<int>(w * scale));
+    int nh = std::max(1, static_cast<int>(h * scale));
+    return cv::Rect((thumb_size - nw) / 2, (thumb_size - nh) / 2, nw, nh);
+}
+
+/// Liczba bitów części ułamkowej wag filtra powierzchniowego (na jedną oś)
+constexpr int AREA_WEIGHT_BITS = 11;
+
+/// Wkład jednego piksela źródłowego w piksel docelowy
+struct AreaTap {
+    int src;
+    uint32_t weight;
+};
+
+/**
+ * @brief Buduje stałoprzecinkowe wagi filtra powierzchniowego dla jednej osi.
+ * @param src_len Długość osi obrazu źródłowego.
+ * @param dst_len Długość osi obrazu docelowego (nie większa niż src_len).
+ * @param taps Wynikowe wagi; dla indeksu docelowego i zajmują zakres [offsets[i], offsets[i + 1]).
+ *             Pojemność jest zachowywana między wywołaniami.
+ * @param offsets Wynikowe granice zakresów w taps (co najmniej dst_len + 1 elementów).
+ */
+inline void build_area_taps(int src_len, int dst_len, std::vector<AreaTap>& taps, int* offsets) {
+    const uint32_t one = 1u << AREA_WEIGHT_BITS;
+    double scale = static_cast<double>(src_len) / dst_len;
+    taps.clear();
+    taps.reserve(src_len + dst_len);
+    offsets[0] = 0;
+    for (int i = 0; i < dst_len; ++i) {
+        double f0 = i * scale, f1 = (i + 1) * scale;
+        int s0 = static_cast<int>(f0);
+        int s1 = std::min(src_len, static_cast<int>(std::ceil(f1)));
+        // Wagi z zaokrąglonych sum narastających: suma wynosi dokładnie 1.0,
+        // a błąd pojedynczej wagi nie przekracza jednego kroku
+        uint32_t covered = 0;
+        for (int s = s0; s < s1; ++s) {
+            double end = s + 1 == s1 ? f1 : std::min(f1, s + 1.0);
+            uint32_t total = static_cast<uint32_t>(std::lround((end - f0) / scale * one));
+            if (total > covered) taps.push_back({ s, total - covered });
+            covered = total;
+        }
+        offsets[i + 1] = static_cast<int>(taps.size());
+    }
+}
+
+/**
+ * @brief Skaluje obraz filtrem powierzchniowym bezpośrednio do miniatury z ramką.
+ *
+ * Rozmiar miniatury i liczba kanałów są znane w czasie kompilacji, więc bufor
+ * wiersza i granice wag leżą na stosie, a pętle po kanałach są rozwijane. Wagi
+ * trafiają do buforów wątku wielokrotnego użytku, więc po rozgrzaniu jądro nie
+ * alokuje pamięci poza samą miniaturą. Obszar poza roi jest zerowany w tym samym
+ * przebiegu, bez pośredniego cv::Mat.
+ * @tparam ThumbSize Rozmiar boku miniatury.
+ * @tparam Channels Liczba kanałów (1 lub 3), obraz 8-bitowy.
+ * @param src Wejściowy obraz, nie mniejszy niż roi.
+ * @param thumb Wynikowa miniatura ThumbSize x ThumbSize.
+ * @param roi Prostokąt docelowy wyznaczony przez thumbnail_roi().
+ */
+template <int ThumbSize, int Channels>
+void area_thumbnail_kernel(const cv::Mat& src, cv::Mat& thumb, const cv::Rect& roi) {
+    constexpr int row_len = ThumbSize * Channels;
+    constexpr int shift = 2 * AREA_WEIGHT_BITS;
+    thumb.create(ThumbSize, ThumbSize, CV_8UC(Channels));
+
+    thread_local std::vector<AreaTap> x_taps, y_taps;
+    std::array<int, ThumbSize + 1> x_offsets, y_offsets;
+    build_area_taps(src.cols, roi.width, x_taps, x_offsets.data());
+    // Dla kwadratowego obrazu wagi obu osi są identyczne
+    bool square = src.cols == src.rows && roi.width == roi.height;
+    if (!square) build_area_taps(src.rows, roi.height, y_taps, y_offsets.data());
+    const std::vector<AreaTap>& row_taps = square ? x_taps : y_taps;
+    const int* row_offsets = square ? x_offsets.data() : y_offsets.data();
+
+    std::array<uint32_t, row_len> acc;
+    const int left = roi.x * Channels;
+    const int width = roi.width * Channels;
+    for (int y = 0; y < ThumbSize; ++y) {
+        uchar* out = thumb.ptr<uchar>(y);
+        int dy = y - roi.y;
+        if (dy < 0 || dy >= roi.height) {
+            std::memset(out, 0, row_len);
+            continue;
+        }
+        std::fill(acc.begin(), acc.begin() + width, 0u);
+        for (int t = row_offsets[dy]; t < row_offsets[dy + 1]; ++t) {
+            const uchar* in = src.ptr<uchar>(row_taps[t].src);
+            const uint32_t wy = row_taps[t].weight;
+            for (int dx = 0; dx < roi.width; ++dx) {
+                uint32_t sum[Channels] = {};
+                for (int k = x_offsets[dx]; k < x_offsets[dx + 1]; ++k) {
+                    const uchar* px = in + x_taps[k].src * Channels;
+                    for (int c = 0; c < Channels; ++c) sum[c] += px[c] * x_taps[k].weight;
+                }
+                for (int c = 0; c < Channels; ++c) acc[dx * Channels + c] += sum[c] * wy;
+            }
+        }
+        std::memset(out, 0, left);
+        for (int i = 0; i < width; ++i)
+            out[left + i] = static_cast<uchar>((acc[i] + (1u << (shift - 1))) >> shift);
+        std::memset(out + left + width, 0, row_len - left - width);
+    }
+}
+
+/// Wskaźnik do wyspecjalizowanego jądra tworzenia miniatury
+typedef void (*thumbnail_kernel)(const cv::Mat& src, cv::Mat& thumb, const cv::Rect& roi);
+
+/**
+ * @brief Wybiera jądro dla danej liczby kanałów przy ustalonym rozmiarze miniatury.
+ * @param type Typ obrazu OpenCV.
+ * @return Wskaźnik do jądra lub nullptr, jeśli typ nie jest obsługiwany.
+ */
+template <int ThumbSize>
+thumbnail_kernel select_thumbnail_kernel(int type) {
+    switch (type) {
+    case CV_8UC1: return area_thumbnail_kernel<ThumbSize, 1>;
+    case CV_8UC3: return area_thumbnail_kernel<ThumbSize, 3>;
+    default: return nullptr;
+    }
+}
+
+/**
+ * @brief Wybiera wyspecjalizowane jądro dla rozmiaru miniatury i typu obrazu.
+ * @param thumb_size Rozmiar boku miniatury.
+ * @param type Typ obrazu OpenCV.
+ * @return Wskaźnik do jądra lub nullptr dla nietypowych rozmiarów i typów.
+ */
+inline thumbnail_kernel find_thumbnail_kernel(int thumb_size, int type) {
+    switch (thumb_size) {
+    case 64: return select_thumbnail_kernel<64>(type);
+    case 100: return select_thumbnail_kernel<100>(type);
+    case 128: return select_thumbnail_kernel<128>(type);
+    case 256: return select_thumbnail_kernel<256>(type);
+    default: return nullptr;
+    }
+}
+
+#endif /* THUMBNAIL_KERNELS_H */
@@ -2,23 +2,63 @@
 #include <iostream>
 #include <filesystem>
 #include <opencv2/opencv.hpp>
+#include "thumbnail_kernels.h"
 #include <vector>
 #include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <cstdio>
+#include <sstream>
+#include <cstdlib>
+#include <functional>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#ifdef POS_HAVE_NUMA
+#include <numa.h>
+#endif
 
 namespace fs = std::filesystem;
 
 /// Globalny mutex do synchronizacji wpisywania na konsolę
 std::mutex cout_mutex;
-/// Globalny mutex do synchronizacji buforów miniaturek
-std::mutex output_mutex;
 
 /// Ścieżka do katalogu wejściowego odczytywania z pliku INI
 std::string input_dir;
 /// Ścieżka do katalogu wyjściowego zdefiniowanego w pliku INI
 std::string output_dir;
+/// Rozmiary miniaturek (malejąco) zdefiniowane w pliku INI
+std::vector<int> thumb_sizes;
+/// Czy zachowywać miniaturki i zapisywać z nich mozaiki
+bool mosaic_enabled = true;
+/// Liczba wątków roboczych (0 = liczba rdzeni)
+unsigned int thread_count = 0;
+/// Liczba wątków wewnętrznej puli OpenCV (0 = domyślna OpenCV)
+int opencv_threads = 1;
+/// Tryb przypinania wątków do rdzeni: none, compact lub scatter
+std::string affinity_mode = "none";
+/// Tryb alokacji buforów wątków: off lub local (w węźle NUMA wątku)
+std::string numa_mode = "off";
+/// Czy raportować dostępy wątków do pamięci zdalnych węzłów NUMA i migracje (perf)
+bool numa_stats = false;
+/// Plik CSV z czasem przetwarzania każdego obrazu (pusty = brak zapisu)
+std::string latency_file;
 /// Atomiczny licznik przetworzonych obrazów
 std::atomic<int> processed_count(0);
 
@@ -57,7 +97,7 @@ int ini_parse(const char* filename, ini_handler handler, void* user) {
     FILE* file = fopen(filename, "r");
     if (!file) return -1;
 
-    char line[200];
+    char line[1024];
     char section[50] = "";
     char prev_name[50] = "";
     int lineno = 0;
@@ -91,7 +131,25 @@ int ini_parse(const char* filename, ini_handler handler, void* user) {
 }
 
 /**
- * @brief Handler dla wpisów INI sekcji [Paths].
+ * @brief Parsuje listę rozmiarów miniaturek rozdzieloną przecinkami.
+ * @param value Napis w postaci "64,128,256".
+ * @return Unikalne dodatnie rozmiary posortowane malejąco.
+ */
+std::vector<int> parse_thumb_sizes(const char* value) {
+    std::vector<int> sizes;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int size = std::atoi(item.c_str());
+        if (size > 0) sizes.push_back(size);
+    }
+    std::sort(sizes.begin(), sizes.end(), std::greater<int>());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    return sizes;
+}
+
+/**
+ * @brief Handler dla wpisów INI sekcji [Paths], [Thumbnails], [Threads] i [Stats].
  * @param user Wskaźnik użytkownika (nieużywany).
  * @param section Nazwa sekcji.
  * @param name Nazwa klucza.
@@ -102,6 +160,17 @@ int my_ini_handler(void* user, const char* section, const char* name, const char
     if (std::string(section) == "Paths") {
         if (std::string(name) == "input_dir") input_dir = value;
         else if (std::string(name) == "output_dir") output_dir = value;
+    } else if (std::string(section) == "Thumbnails") {
+        if (std::string(name) == "sizes") thumb_sizes = parse_thumb_sizes(value);
+        else if (std::string(name) == "mosaic") mosaic_enabled = std::atoi(value) != 0;
+    } else if (std::string(section) == "Threads") {
+        if (std::string(name) == "count") thread_count = static_cast<unsigned int>(std::max(0, std::atoi(value)));
+        else if (std::string(name) == "opencv_threads") opencv_threads = std::max(0, std::atoi(value));
+        else if (std::string(name) == "affinity") affinity_mode = value;
+        else if (std::string(name) == "numa") numa_mode = value;
+        else if (std::string(name) == "numa_stats") numa_stats = std::atoi(value) != 0;
+    } else if (std::string(section) == "Stats") {
+        if (std::string(name) == "latency_file") latency_file = value;
     }
     return 1;
 }
@@ -120,73 +189,461 @@ cv::Mat detect_edges(const cv::Mat& image) {
 }
 
 /**
- * @brief Tworzy kwadratową miniaturę obrazu z zachowaniem proporcji.
- * @param src Wejściowy obraz.
+ * @brief Tworzy kwadratową miniaturę, skalując obraz do zadanego prostokąta.
+ * @param src Wejściowy obraz (lub fragment poprzedniego poziomu piramidy).
  * @param thumb_size Rozmiar boku miniatury.
+ * @param roi Prostokąt docelowy wyznaczony przez thumbnail_roi().
  * @return Miniatura o wymiarach thumb_size x thumb_size.
  */
-cv::Mat make_thumbnail(const cv::Mat& src, int thumb_size) {
-    int w = src.cols, h = src.rows;
-    float scale = thumb_size / static_cast<float>(std::max(w, h));
-    int nw = static_cast<int>(w * scale);
-    int nh = static_cast<int>(h * scale);
+cv::Mat make_thumbnail(const cv::Mat& src, int thumb_size, const cv::Rect& roi) {
+    // Przy zmniejszaniu filtr powierzchniowy nie gubi szczegółów (np. cienkich krawędzi)
+    bool shrink = roi.width <= src.cols && roi.height <= src.rows;
+    thumbnail_kernel kernel = find_thumbnail_kernel(thumb_size, src.type());
+    if (kernel && shrink) {
+        cv::Mat thumb;
+        kernel(src, thumb, roi);
+        return thumb;
+    }
 
     cv::Mat resized;
-    cv::resize(src, resized, cv::Size(nw, nh));
+    cv::resize(src, resized, roi.size(), 0, 0, shrink ? cv::INTER_AREA : cv::INTER_LINEAR);
 
     cv::Mat thumb(thumb_size, thumb_size, src.type(), cv::Scalar::all(0));
-    int x = (thumb_size - nw) / 2;
-    int y = (thumb_size - nh) / 2;
-    resized.copyTo(thumb(cv::Rect(x, y, nw, nh)));
+    resized.copyTo(thumb(roi));
     return thumb;
 }
 
+/**
+ * @brief Tworzy piramidę miniatur w jednym kaskadowym przebiegu.
+ *
+ * Każdy poziom jest skalowany z obszaru obrazu poprzedniego (większego) poziomu,
+ * więc pełny obraz jest odczytywany tylko raz.
+ * @param src Wejściowy obraz.
+ * @param sizes Rozmiary miniatur posortowane malejąco.
+ * @return Miniatury w kolejności odpowiadającej sizes.
+ */
+std::vector<cv::Mat> make_thumbnail_pyramid(const cv::Mat& src, const std::vector<int>& sizes) {
+    std::vector<cv::Mat> pyramid;
+    pyramid.reserve(sizes.size());
+    cv::Mat level = src;
+    for (int size : sizes) {
+        cv::Rect roi = thumbnail_roi(src.cols, src.rows, size);
+        cv::Mat thumb = make_thumbnail(level, size, roi);
+        level = thumb(roi);
+        pyramid.push_back(thumb);
+    }
+    return pyramid;
+}
+
 /**
  * @brief Przetwarza pojedynczy obraz: wykrywa krawędzie, zapisuje wynik i tworzy miniaturki.
  * @param path Ścieżka do pliku obrazu.
- * @param thumbs_original Wektor miniatur oryginalnych obrazów.
- * @param thumbs_processed Wektor miniatur przetworzonych obrazów.
- * @param thumb_size Rozmiar miniaturki (kwadrat).
+ * @param thumbs_original Miniatury oryginalnych obrazów (bufor wątku), osobny wektor dla każdego rozmiaru.
+ * @param thumbs_processed Miniatury przetworzonych obrazów (bufor wątku), osobny wektor dla każdego rozmiaru.
+ * @return true, jeśli obraz został wczytany i przetworzony.
  */
-void process_image(const fs::path& path, std::vector<cv::Mat>& thumbs_original, std::vector<cv::Mat>& thumbs_processed, int thumb_size = 100) {
+bool process_image(const fs::path& path, std::vector<std::vector<cv::Mat>>& thumbs_original, std::vector<std::vector<cv::Mat>>& thumbs_processed) {
     try {
         cv::Mat img = cv::imread(path.string());
-        if (img.empty()) return;
+        if (img.empty()) return false;
         cv::Mat edges = detect_edges(img);
         std::string out_path = output_dir + "/" + path.filename().string();
         cv::imwrite(out_path, edges);
 
-        cv::Mat th_o = make_thumbnail(img, thumb_size);
-        cv::Mat th_p = make_thumbnail(edges, thumb_size);
-        {
-            std::lock_guard<std::mutex> lock(output_mutex);
-            thumbs_original.push_back(th_o);
-            thumbs_processed.push_back(th_p);
+        std::vector<cv::Mat> th_o = make_thumbnail_pyramid(img, thumb_sizes);
+        std::vector<cv::Mat> th_p = make_thumbnail_pyramid(edges, thumb_sizes);
+        // Bez mozaik miniaturki są tylko liczone, aby pamięć nie rosła z liczbą obrazów
+        for (size_t i = 0; mosaic_enabled && i < thumb_sizes.size(); ++i) {
+            thumbs_original[i].push_back(th_o[i]);
+            thumbs_processed[i].push_back(th_p[i]);
         }
         processed_count++;
+        return true;
     } catch (...) {
         std::lock_guard<std::mutex> lock(cout_mutex);
         std::cerr << "Błąd przetwarzania pliku: " << path << "\n";
+        return false;
     }
 }
 
 /**
  * @brief Przetwarza obrazy w celu stworzenia kolarzu.
  * @param thumbs Zdjęcia do stworzenia kolarzu,
+ * @param first Indeks pierwszego zdjęcia w kolarzu.
+ * @param count Liczba zdjęć w kolarzu.
+ * @param cols Liczba kolumn.
  * @return Wynikowy kolarz zdjec.
  */
-cv::Mat create_thumbnail_grid(const std::vector<cv::Mat>& thumbs, size_t cols = 10) {
-    if (thumbs.empty()) return {};
-    int thumb_size = thumbs[0].cols; // kwadrat
-    size_t rows = (thumbs.size() + cols - 1) / cols;
-    cv::Mat canvas(thumb_size * static_cast<int>(rows), thumb_size * static_cast<int>(cols), thumbs[0].type(), cv::Scalar::all(0));
-    for (size_t i = 0; i < thumbs.size(); ++i) {
+cv::Mat create_thumbnail_grid(const std::vector<cv::Mat>& thumbs, size_t first, size_t count, size_t cols = 10) {
+    if (count == 0) return {};
+    int thumb_size = thumbs[first].cols; // kwadrat
+    size_t rows = (count + cols - 1) / cols;
+    cv::Mat canvas(thumb_size * static_cast<int>(rows), thumb_size * static_cast<int>(cols), thumbs[first].type(), cv::Scalar::all(0));
+    for (size_t i = 0; i < count; ++i) {
         size_t r = i / cols, c = i % cols;
-        thumbs[i].copyTo(canvas(cv::Rect(static_cast<int>(c * thumb_size), static_cast<int>(r * thumb_size), thumb_size, thumb_size)));
+        thumbs[first + i].copyTo(canvas(cv::Rect(static_cast<int>(c * thumb_size), static_cast<int>(r * thumb_size), thumb_size, thumb_size)));
     }
     return canvas;
 }
 
+/// Maksymalna wysokość obrazu JPEG
+constexpr int JPEG_MAX_DIMENSION = 65500;
+
+/**
+ * @brief Zapisuje mozaikę miniaturek, dzieląc ją na strony mieszczące się w limicie JPEG.
+ * @param thumbs Miniatury jednego rozmiaru.
+ * @param name Ścieżka bez rozszerzenia; kolejne strony dostają przyrostek _2, _3, ...
+ * @param cols Liczba kolumn.
+ */
+void write_thumbnail_mosaic(const std::vector<cv::Mat>& thumbs, const std::string& name, size_t cols = 10) {
+    if (thumbs.empty()) return;
+    size_t per_page = cols * std::max(1, JPEG_MAX_DIMENSION / thumbs[0].rows);
+    for (size_t first = 0, page = 1; first < thumbs.size(); first += per_page, ++page) {
+        size_t count = std::min(per_page, thumbs.size() - first);
+        std::string path = name + (page > 1 ? "_" + std::to_string(page) : "") + ".jpg";
+        cv::imwrite(path, create_thumbnail_grid(thumbs, first, count, cols));
+    }
+}
+
+/**
+ * @brief Parsuje listę procesorów (lub węzłów) w formacie jądra Linux, np. "0-3,8-11".
+ * @param list Napis z listą procesorów.
+ * @return Numery procesorów.
+ */
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty() || !std::isdigit(static_cast<unsigned char>(item[0]))) continue;
+        int first = std::atoi(item.c_str()), last = first;
+        size_t dash = item.find('-');
+        if (dash != std::string::npos) last = std::atoi(item.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+/**
+ * @brief Odczytuje numery węzłów NUMA w trybie online.
+ *
+ * Numeracja może mieć luki (np. node0 i node2), więc węzłów nie wolno wyliczać po kolei.
+ * @return Numery węzłów; pusty wektor, jeśli sysfs jest niedostępny.
+ */
+std::vector<int> online_numa_nodes() {
+    std::vector<int> nodes;
+#ifdef __linux__
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string list;
+    if (file && std::getline(file, list)) nodes = parse_cpu_list(list);
+#endif
+    return nodes;
+}
+
+/// Węzeł NUMA z procesorami dostępnymi dla procesu
+struct NumaNode {
+    /// Numer węzła w systemie (nodeN w sysfs)
+    int id;
+    std::vector<int> cpus;
+};
+
+/**
+ * @brief Odczytuje procesory należące do każdego węzła NUMA.
+ *
+ * Poza Linuksem (lub gdy sysfs jest niedostępny) zwraca jeden węzeł ze wszystkimi rdzeniami.
+ * @return Węzły, na których proces może działać.
+ */
+std::vector<NumaNode> read_numa_topology() {
+    std::vector<NumaNode> nodes;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    for (int node : online_numa_nodes()) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) continue;
+        std::string list;
+        std::getline(file, list);
+        std::vector<int> cpus;
+        for (int cpu : parse_cpu_list(list))
+            if (!have_mask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) cpus.push_back(cpu);
+        if (!cpus.empty()) nodes.push_back({ node, cpus });
+    }
+#endif
+    if (nodes.empty()) {
+        unsigned int n = std::max(1u, std::thread::hardware_concurrency());
+        nodes.push_back({ 0, {} });
+        for (unsigned int cpu = 0; cpu < n; ++cpu) nodes[0].cpus.push_back(static_cast<int>(cpu));
+    }
+    return nodes;
+}
+
+/**
+ * @brief Wyznacza zbiór procesorów, na których może działać dany wątek roboczy.
+ *
+ * compact zapełnia kolejne węzły, scatter rozkłada wątki na przemian między węzłami.
+ * Bez przypinania, ale z numa=local, wątek jest wiązany z całym węzłem.
+ * @param worker Numer wątku roboczego.
+ * @param nodes Topologia z read_numa_topology().
+ * @return Procesory dla wątku; pusta lista oznacza brak przypinania.
+ */
+std::vector<int> worker_cpus(unsigned int worker, const std::vector<NumaNode>& nodes) {
+    if (affinity_mode == "compact" || affinity_mode == "scatter") {
+        std::vector<int> order;
+        if (affinity_mode == "compact") {
+            for (auto& node : nodes) order.insert(order.end(), node.cpus.begin(), node.cpus.end());
+        } else {
+            for (size_t i = 0;; ++i) {
+                size_t count = order.size();
+                for (auto& node : nodes)
+                    if (i < node.cpus.size()) order.push_back(node.cpus[i]);
+                if (order.size() == count) break;
+            }
+        }
+        return { order[worker % order.size()] };
+    }
+    if (numa_mode == "local" && nodes.size() > 1) return nodes[worker % nodes.size()].cpus;
+    return {};
+}
+
+/**
+ * @brief Wyznacza węzeł NUMA, do którego należą procesory wątku.
+ * @param cpus Procesory z worker_cpus().
+ * @param nodes Topologia z read_numa_topology().
+ * @return Numer węzła lub -1, jeśli wątek nie jest przypięty.
+ */
+int worker_node(const std::vector<int>& cpus, const std::vector<NumaNode>& nodes) {
+    if (cpus.empty()) return -1;
+    for (auto& node : nodes)
+        if (std::find(node.cpus.begin(), node.cpus.end(), cpus[0]) != node.cpus.end()) return node.id;
+    return -1;
+}
+
+/**
+ * @brief Przypina bieżący wątek do podanych procesorów.
+ * @param cpus Numery procesorów.
+ * @return true, jeśli przypięcie się powiodło.
+ */
+bool pin_current_thread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus)
+        if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) mask |= DWORD_PTR(1) << cpu;
+    return mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Kieruje alokacje pamięci bieżącego wątku do podanego węzła NUMA.
+ *
+ * Z libnuma ustawia węzeł preferowany, więc strony trafiają do niego niezależnie
+ * od polityki odziedziczonej po procesie (np. numactl --interleave). Bez libnuma
+ * polega na first-touch: bufory wątku są tworzone dopiero w nim, po przypięciu.
+ * @param node Numer węzła z worker_node(); -1 oznacza brak zmian.
+ */
+void use_local_numa_memory(int node) {
+#ifdef POS_HAVE_NUMA
+    if (node >= 0 && numa_available() >= 0) numa_set_preferred(node);
+#else
+    (void)node;
+#endif
+}
+
+/// Liczniki sprzętowe jednego wątku roboczego; -1 oznacza licznik niedostępny
+struct WorkerPerfCounters {
+    /// Odczyty obsłużone przez pamięć dowolnego węzła (PERF_COUNT_HW_CACHE_NODE, access)
+    long long node_reads = -1;
+    /// Odczyty obsłużone przez pamięć innego węzła (PERF_COUNT_HW_CACHE_NODE, miss)
+    long long remote_node_reads = -1;
+    /// Przeniesienia wątku między procesorami
+    long long cpu_migrations = -1;
+};
+
+/// Deskryptory liczników perf bieżącego wątku (-1 = nieotwarty)
+typedef std::array<int, 3> perf_fds;
+
+#ifdef __linux__
+/**
+ * @brief Otwiera licznik perf dla bieżącego wątku na dowolnym procesorze.
+ *
+ * Najpierw próbuje liczyć także zdarzenia w jądrze; przy perf_event_paranoid >= 2
+ * ponawia próbę tylko dla przestrzeni użytkownika.
+ * @param type Typ zdarzenia (PERF_TYPE_*).
+ * @param config Konfiguracja zdarzenia.
+ * @return Deskryptor lub -1.
+ */
+int open_perf_counter(uint32_t type, uint64_t config) {
+    for (int exclude_kernel = 0; exclude_kernel <= 1; ++exclude_kernel) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = exclude_kernel;
+        attr.exclude_hv = 1;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd >= 0) return fd;
+    }
+    return -1;
+}
+#endif
+
+/**
+ * @brief Uruchamia liczniki dostępów do pamięci węzłów i migracji dla bieżącego wątku.
+ * @return Deskryptory liczników; na systemach innych niż Linux wszystkie równe -1.
+ */
+perf_fds start_worker_perf_counters() {
+    perf_fds fds = { -1, -1, -1 };
+#ifdef __linux__
+    const uint64_t node_read = PERF_COUNT_HW_CACHE_NODE | (PERF_COUNT_HW_CACHE_OP_READ << 8);
+    fds[0] = open_perf_counter(PERF_TYPE_HW_CACHE, node_read | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16));
+    fds[1] = open_perf_counter(PERF_TYPE_HW_CACHE, node_read | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    fds[2] = open_perf_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS);
+#endif
+    return fds;
+}
+
+/**
+ * @brief Odczytuje i zamyka liczniki otwarte przez start_worker_perf_counters().
+ * @param fds Deskryptory liczników.
+ * @return Wartości liczników.
+ */
+WorkerPerfCounters stop_worker_perf_counters(const perf_fds& fds) {
+    long long values[3] = { -1, -1, -1 };
+#ifdef __linux__
+    for (size_t i = 0; i < fds.size(); ++i) {
+        if (fds[i] < 0) continue;
+        long long value = 0;
+        if (read(fds[i], &value, sizeof(value)) == sizeof(value)) values[i] = value;
+        close(fds[i]);
+    }
+#else
+    (void)fds;
+#endif
+    WorkerPerfCounters c;
+    c.node_reads = values[0];
+    c.remote_node_reads = values[1];
+    c.cpu_migrations = values[2];
+    return c;
+}
+
+/**
+ * @brief Wypisuje liczniki sprzętowe wątków: dostępy do pamięci zdalnych węzłów i migracje.
+ * @param counters Liczniki kolejnych wątków roboczych.
+ * @param nodes Węzły NUMA kolejnych wątków (-1 = nieprzypięty).
+ */
+void report_worker_perf_counters(const std::vector<WorkerPerfCounters>& counters, const std::vector<int>& nodes) {
+    long long reads = 0, remote = 0, migrations = 0;
+    bool have_node = false, have_migrations = false;
+    for (size_t w = 0; w < counters.size(); ++w) {
+        const WorkerPerfCounters& c = counters[w];
+        std::cout << "Watek " << w << " (wezel " << nodes[w] << "):";
+        if (c.node_reads >= 0 && c.remote_node_reads >= 0) {
+            have_node = true;
+            reads += c.node_reads;
+            remote += c.remote_node_reads;
+            std::cout << " odczyty pamieci=" << c.node_reads << " zdalne=" << c.remote_node_reads;
+        } else {
+            std::cout << " odczyty pamieci=niedostepne";
+        }
+        if (c.cpu_migrations >= 0) {
+            have_migrations = true;
+            migrations += c.cpu_migrations;
+            std::cout << " migracje=" << c.cpu_migrations;
+        }
+        std::cout << "\n";
+    }
+    if (have_node) {
+        std::cout << "Odczyty z pamieci zdalnych wezlow: " << remote << " z " << reads;
+        if (reads) std::cout << " (" << 100.0 * remote / reads << "%)";
+        std::cout << "\n";
+    } else {
+        std::cout << "Liczniki PERF_COUNT_HW_CACHE_NODE niedostepne (brak wsparcia CPU/VM lub perf_event_paranoid).\n";
+    }
+    if (have_migrations) std::cout << "Migracje watkow: " << migrations << "\n";
+}
+
+/// Liczniki alokacji stron jednego węzła NUMA (z /sys/devices/system/node/nodeN/numastat)
+struct NumaCounters {
+    /// Numer węzła w systemie (nodeN w sysfs)
+    int node = 0;
+    long long hit = 0;
+    long long miss = 0;
+    long long foreign = 0;
+    long long local_node = 0;
+    long long other_node = 0;
+};
+
+/**
+ * @brief Odczytuje liczniki alokacji dla wszystkich węzłów NUMA.
+ * @return Liczniki kolejnych węzłów; pusty wektor, jeśli są niedostępne.
+ */
+std::vector<NumaCounters> read_numa_counters() {
+    std::vector<NumaCounters> counters;
+#ifdef __linux__
+    for (int node : online_numa_nodes()) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/numastat");
+        if (!file) continue;
+        NumaCounters c;
+        c.node = node;
+        std::string name;
+        long long value;
+        while (file >> name >> value) {
+            if (name == "numa_hit") c.hit = value;
+            else if (name == "numa_miss") c.miss = value;
+            else if (name == "numa_foreign") c.foreign = value;
+            else if (name == "local_node") c.local_node = value;
+            else if (name == "other_node") c.other_node = value;
+        }
+        counters.push_back(c);
+    }
+#endif
+    return counters;
+}
+
+/**
+ * @brief Wypisuje przyrost liczników alokacji stron NUMA w trakcie przetwarzania.
+ *
+ * Liczniki dotyczą wyłącznie alokacji (nie dostępów do pamięci): other_node to
+ * strony zaalokowane w innym węźle niż ten, na którym działał proces alokujący.
+ * Są systemowe, więc obejmują też inne procesy.
+ * @param before Liczniki sprzed przetwarzania.
+ * @param after Liczniki po przetwarzaniu.
+ */
+void report_numa_counters(const std::vector<NumaCounters>& before, const std::vector<NumaCounters>& after) {
+    bool same_nodes = before.size() == after.size();
+    for (size_t i = 0; same_nodes && i < after.size(); ++i) same_nodes = before[i].node == after[i].node;
+    if (before.empty() || !same_nodes) {
+        std::cout << "Liczniki alokacji NUMA niedostepne.\n";
+        return;
+    }
+    long long local_total = 0, other_total = 0;
+    for (size_t node = 0; node < after.size(); ++node) {
+        long long local = after[node].local_node - before[node].local_node;
+        long long other = after[node].other_node - before[node].other_node;
+        local_total += local;
+        other_total += other;
+        std::cout << "Alokacje stron, wezel " << after[node].node
+                  << ": numa_hit=" << after[node].hit - before[node].hit
+                  << " numa_miss=" << after[node].miss - before[node].miss
+                  << " numa_foreign=" << after[node].foreign - before[node].foreign
+                  << " local_node=" << local
+                  << " other_node=" << other << "\n";
+    }
+    long long total = local_total + other_total;
+    std::cout << "Alokacje stron w zdalnym wezle (numastat, caly system): " << other_total << " z " << total;
+    if (total) std::cout << " (" << 100.0 * other_total / total << "%)";
+    std::cout << "\n";
+}
+
 /**
  * @brief Główna funkcja programu.
  * @param argc Liczba argumentów linii poleceń.
@@ -206,6 +663,15 @@ int main(int argc, char* argv[]) {
         std::cerr << "Nieprawidlowa sciezka wejsciowa: " << input_dir << "\n";
         return 1;
     }
+    if (affinity_mode != "none" && affinity_mode != "compact" && affinity_mode != "scatter") {
+        std::cerr << "Nieprawidlowy tryb affinity (none, compact, scatter): " << affinity_mode << "\n";
+        return 1;
+    }
+    if (numa_mode != "off" && numa_mode != "local") {
+        std::cerr << "Nieprawidlowy tryb numa (off, local): " << numa_mode << "\n";
+        return 1;
+    }
+    if (thumb_sizes.empty()) thumb_sizes = { 100 };
     fs::create_directories(output_dir);
 
     std::vector<fs::path> image_files;
@@ -217,26 +683,103 @@ int main(int argc, char* argv[]) {
             image_files.push_back(entry.path());
     }
 
-    std::vector<cv::Mat> thumbs_orig, thumbs_proc;
-    std::vector<std::thread> threads;
     unsigned int max_t = std::thread::hardware_concurrency();
-    unsigned int limit = max_t ? max_t : 4;
-    for (auto& path : image_files) {
-        threads.emplace_back([&path, &thumbs_orig, &thumbs_proc]() {
-            process_image(path, thumbs_orig, thumbs_proc);
+    unsigned int limit = thread_count ? thread_count : (max_t ? max_t : 4);
+    std::vector<NumaNode> nodes = read_numa_topology();
+
+    // Każdy wątek ma własne bufory miniaturek, tworzone w nim samym po przypięciu,
+    // dzięki czemu trafiają do pamięci jego węzła i nie wymagają blokady
+    struct WorkerOutput {
+        std::vector<std::vector<cv::Mat>> thumbs_orig, thumbs_proc;
+        std::vector<std::pair<size_t, double>> latencies_us;
+        WorkerPerfCounters perf;
+        int node = -1;
+    };
+    std::vector<WorkerOutput> outputs(limit);
+    std::atomic<size_t> next_image(0);
+
+    std::vector<NumaCounters> counters_before;
+    if (numa_stats) counters_before = read_numa_counters();
+    auto start = std::chrono::steady_clock::now();
+
+    // Liczba wątków OpenCV nie zależy od affinity ani numa, więc porównywane
+    // przebiegi różnią się tylko rozmieszczeniem wątków. Domyślne 1 pozostawia
+    // równoległość wątkom roboczym; pula parallel_for_ powstaje w pierwszym
+    // wywołującym wątku i dziedziczy jego maskę, więc przy przypinaniu i
+    // opencv_threads > 1 trafiłaby na jeden rdzeń.
+    if (opencv_threads > 0) cv::setNumThreads(opencv_threads);
+
+    std::vector<std::thread> threads;
+    for (unsigned int w = 0; w < limit; ++w) {
+        threads.emplace_back([w, &nodes, &outputs, &next_image, &image_files]() {
+            std::vector<int> cpus = worker_cpus(w, nodes);
+            if (!cpus.empty() && !pin_current_thread(cpus)) {
+                std::lock_guard<std::mutex> lock(cout_mutex);
+                std::cerr << "Nie mozna przypiac watku " << w << "\n";
+            }
+            outputs[w].node = worker_node(cpus, nodes);
+            if (numa_mode == "local") use_local_numa_memory(outputs[w].node);
+            perf_fds perf = { -1, -1, -1 };
+            if (numa_stats) perf = start_worker_perf_counters();
+
+            std::vector<std::vector<cv::Mat>> thumbs_orig(thumb_sizes.size()), thumbs_proc(thumb_sizes.size());
+            std::vector<std::pair<size_t, double>> latencies_us;
+            for (size_t i = next_image++; i < image_files.size(); i = next_image++) {
+                auto image_start = std::chrono::steady_clock::now();
+                bool ok = process_image(image_files[i], thumbs_orig, thumbs_proc);
+                // Nieudane obrazy (pominięte lub z wyjątkiem) zaniżałyby percentyle latencji
+                if (ok && !latency_file.empty()) {
+                    std::chrono::duration<double, std::micro> latency = std::chrono::steady_clock::now() - image_start;
+                    latencies_us.emplace_back(i, latency.count());
+                }
+            }
+            outputs[w].thumbs_orig = std::move(thumbs_orig);
+            outputs[w].thumbs_proc = std::move(thumbs_proc);
+            outputs[w].latencies_us = std::move(latencies_us);
+            if (numa_stats) outputs[w].perf = stop_worker_perf_counters(perf);
         });
-        if (threads.size() >= limit) {
-            for (auto& t : threads) t.join();
-            threads.clear();
-        }
     }
     for (auto& t : threads) t.join();
 
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::vector<std::vector<cv::Mat>> thumbs_orig(thumb_sizes.size()), thumbs_proc(thumb_sizes.size());
+    for (auto& out : outputs) {
+        for (size_t i = 0; i < thumb_sizes.size(); ++i) {
+            thumbs_orig[i].insert(thumbs_orig[i].end(), out.thumbs_orig[i].begin(), out.thumbs_orig[i].end());
+            thumbs_proc[i].insert(thumbs_proc[i].end(), out.thumbs_proc[i].begin(), out.thumbs_proc[i].end());
+        }
+    }
+
     std::cout << "Przetworzono " << processed_count.load() << " obrazow.\n";
+    if (!latency_file.empty()) {
+        std::ofstream csv(latency_file);
+        if (!csv) {
+            std::cerr << "Nie mozna zapisac pliku: " << latency_file << "\n";
+        } else {
+            csv << "plik,latencja_us\n";
+            for (auto& out : outputs)
+                for (auto& [i, us] : out.latencies_us)
+                    csv << image_files[i].filename().string() << "," << us << "\n";
+        }
+    }
+    if (numa_stats) {
+        std::cout << "Watki: " << limit << ", wezly NUMA: " << nodes.size()
+                  << ", czas: " << elapsed.count() << " s, przepustowosc: "
+                  << processed_count.load() / std::max(elapsed.count(), 1e-9) << " obrazow/s\n";
+        std::vector<WorkerPerfCounters> perf;
+        std::vector<int> worker_nodes;
+        for (auto& out : outputs) {
+            perf.push_back(out.perf);
+            worker_nodes.push_back(out.node);
+        }
+        report_worker_perf_counters(perf, worker_nodes);
+        report_numa_counters(counters_before, read_numa_counters());
+    }
 
-    cv::Mat grid1 = create_thumbnail_grid(thumbs_orig);
-    cv::Mat grid2 = create_thumbnail_grid(thumbs_proc);
-    if (!grid1.empty()) cv::imwrite(output_dir + "/thumbnails_original.jpg", grid1);
-    if (!grid2.empty()) cv::imwrite(output_dir + "/thumbnails_processed.jpg", grid2);
+    for (size_t i = 0; mosaic_enabled && i < thumb_sizes.size(); ++i) {
+        std::string suffix = "_" + std::to_string(thumb_sizes[i]);
+        write_thumbnail_mosaic(thumbs_orig[i], output_dir + "/thumbnails_original" + suffix);
+        write_thumbnail_mosaic(thumbs_proc[i], output_dir + "/thumbnails_processed" + suffix);
+    }
     return 0;
 }
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include "thumbnail_kernels.h"
+#include <vector>
+#include <string>
+
+/**
+ * @brief Tworzy obraz testowy: szum z nałożonym gradientem i ostrymi krawędziami.
+ * @param size Rozmiar obrazu.
+ * @param channels Liczba kanałów (1 lub 3).
+ * @param rng Generator liczb losowych.
+ * @return Obraz 8-bitowy.
+ */
+cv::Mat make_test_image(cv::Size size, int channels, cv::RNG& rng) {
+    cv::Mat img(size, CV_8UC(channels));
+    rng.fill(img, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+    for (int y = 0; y < size.height; ++y) {
+        uchar* row = img.ptr<uchar>(y);
+        for (int x = 0; x < size.width * channels; ++x)
+            if ((x / channels / 7 + y / 5) % 3 == 0) row[x] = static_cast<uchar>(255 * x / (size.width * channels));
+    }
+    return img;
+}
+
+/**
+ * @brief Porównuje wyspecjalizowane jądro z cv::resize(..., INTER_AREA) z ramką.
+ * @param src Obraz wejściowy (może być fragmentem większego obrazu).
+ * @param thumb_size Rozmiar boku miniatury.
+ * @return Największa bezwzględna różnica pikseli lub -1, jeśli brak jądra.
+ */
+double compare_with_inter_area(const cv::Mat& src, int thumb_size) {
+    thumbnail_kernel kernel = find_thumbnail_kernel(thumb_size, src.type());
+    if (!kernel) return -1;
+    cv::Rect roi = thumbnail_roi(src.cols, src.rows, thumb_size);
+
+    cv::Mat resized;
+    cv::resize(src, resized, roi.size(), 0, 0, cv::INTER_AREA);
+    cv::Mat expected(thumb_size, thumb_size, src.type(), cv::Scalar::all(0));
+    resized.copyTo(expected(roi));
+
+    cv::Mat thumb;
+    kernel(src, thumb, roi);
+    if (thumb.size() != expected.size() || thumb.type() != expected.type()) return 256;
+    return cv::norm(thumb, expected, cv::NORM_INF);
+}
+
+/**
+ * @brief Sprawdza, że jądra miniatur nie odbiegają od INTER_AREA o więcej niż 1.
+ * @return Kod zakończenia (0 = wszystkie przypadki zgodne, 1 = błąd).
+ */
+int main() {
+    const int sizes[] = { 64, 100, 128, 256 };
+    const int channel_counts[] = { 1, 3 };
+    // Kwadraty, proporcje całkowite i niecałkowite, skrajnie wąskie oraz równe miniaturze
+    const cv::Size sources[] = {
+        { 256, 256 }, { 640, 480 }, { 480, 640 }, { 333, 517 }, { 1000, 37 },
+        { 37, 1000 }, { 257, 129 }, { 1920, 1080 }, { 100, 100 }, { 64, 200 },
+    };
+
+    cv::RNG rng(12345);
+    int checked = 0, failed = 0;
+    for (int channels : channel_counts) {
+        for (const cv::Size& size : sources) {
+            cv::Mat img = make_test_image(size, channels, rng);
+            // Fragment większego obrazu sprawdza obsługę kroku wiersza (jak w kaskadzie piramidy)
+            cv::Mat padded = make_test_image(cv::Size(size.width + 9, size.height + 5), channels, rng);
+            cv::Mat view = padded(cv::Rect(4, 3, size.width, size.height));
+            for (int thumb_size : sizes) {
+                cv::Rect roi = thumbnail_roi(size.width, size.height, thumb_size);
+                if (roi.width > size.width || roi.height > size.height) continue; // jądro tylko zmniejsza
+                for (const cv::Mat* src : { &img, &view }) {
+                    double diff = compare_with_inter_area(*src, thumb_size);
+                    ++checked;
+                    if (diff < 0 || diff > 1) {
+                        ++failed;
+                        std::cerr << "Rozbieznosc: " << size.width << "x" << size.height << " C" << channels
+                                  << " -> " << thumb_size << (src == &view ? " (fragment)" : "")
+                                  << ": " << diff << "\n";
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "Sprawdzono " << checked << " przypadkow, bledow: " << failed << "\n";
+    return failed ? 1 : 0;
+}
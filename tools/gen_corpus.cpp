@@ -0,0 +1,183 @@
+#include <iostream>
+#include <filesystem>
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+
+namespace fs = std::filesystem;
+
+/// Rozkład rozmiarów generowanych obrazów
+struct ResolutionSpec {
+    /// fixed, uniform lub lognormal
+    std::string kind = "uniform";
+    /// fixed: szerokość; uniform: minimalny dłuższy bok; lognormal: mediana dłuższego boku
+    int a = 64;
+    /// fixed: wysokość; uniform: maksymalny dłuższy bok
+    int b = 512;
+};
+
+/**
+ * @brief Parsuje opis rozkładu rozmiarów: "fixed:WxH", "uniform:MIN-MAX" lub "lognormal:MEDIANA".
+ * @param text Opis rozkładu.
+ * @param spec Wynikowy rozkład.
+ * @return true, jeśli opis jest poprawny.
+ */
+bool parse_resolution(const std::string& text, ResolutionSpec& spec) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos) return false;
+    spec.kind = text.substr(0, colon);
+    std::string args = text.substr(colon + 1);
+    if (spec.kind == "fixed") return std::sscanf(args.c_str(), "%dx%d", &spec.a, &spec.b) == 2 && spec.a > 0 && spec.b > 0;
+    if (spec.kind == "uniform") return std::sscanf(args.c_str(), "%d-%d", &spec.a, &spec.b) == 2 && spec.a > 0 && spec.b >= spec.a;
+    if (spec.kind == "lognormal") return std::sscanf(args.c_str(), "%d", &spec.a) == 1 && spec.a > 0;
+    return false;
+}
+
+/**
+ * @brief Losuje rozmiar obrazu zgodnie z rozkładem.
+ * @param spec Rozkład rozmiarów.
+ * @param rng Generator liczb losowych obrazu.
+ * @return Rozmiar obrazu.
+ */
+cv::Size random_size(const ResolutionSpec& spec, cv::RNG& rng) {
+    if (spec.kind == "fixed") return cv::Size(spec.a, spec.b);
+    int longer = spec.kind == "uniform"
+        ? rng.uniform(spec.a, spec.b + 1)
+        : static_cast<int>(spec.a * std::exp(0.5 * rng.gaussian(1.0)));
+    longer = std::clamp(longer, 16, 8192);
+    // Proporcje od 1:2 do 2:1, orientacja pozioma lub pionowa
+    int shorter = std::max(1, static_cast<int>(longer * rng.uniform(0.5, 1.0)));
+    return rng.uniform(0, 2) ? cv::Size(longer, shorter) : cv::Size(shorter, longer);
+}
+
+/**
+ * @brief Tworzy syntetyczny obraz z gradientem, figurami i szumem, aby detektor krawędzi miał co robić.
+ * @param size Rozmiar obrazu.
+ * @param rng Generator liczb losowych obrazu.
+ * @return Obraz BGR.
+ */
+cv::Mat synthesize_image(cv::Size size, cv::RNG& rng) {
+    cv::Mat img(size, CV_8UC3);
+    cv::Vec3b c0(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+    cv::Vec3b c1(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+    for (int y = 0; y < size.height; ++y) {
+        cv::Vec3b* row = img.ptr<cv::Vec3b>(y);
+        float t = size.height > 1 ? y / static_cast<float>(size.height - 1) : 0.f;
+        for (int x = 0; x < size.width; ++x)
+            for (int c = 0; c < 3; ++c) row[x][c] = static_cast<uchar>(c0[c] + t * (c1[c] - c0[c]));
+    }
+
+    int shapes = rng.uniform(5, 30);
+    int extent = std::max(size.width, size.height);
+    for (int i = 0; i < shapes; ++i) {
+        cv::Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        cv::Point p1(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        cv::Point p2(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        int thickness = rng.uniform(0, 3) ? rng.uniform(1, 4) : cv::FILLED;
+        switch (rng.uniform(0, 3)) {
+        case 0: cv::rectangle(img, p1, p2, color, thickness); break;
+        case 1: cv::circle(img, p1, rng.uniform(1, std::max(2, extent / 4)), color, thickness); break;
+        default: cv::line(img, p1, p2, color, std::max(1, thickness)); break;
+        }
+    }
+
+    // Szum w zakresie [-8, 8), z nasyceniem na obu krańcach
+    cv::Mat noise(size, CV_8UC3);
+    rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(16));
+    img += noise;
+    img -= cv::Scalar::all(8);
+    return img;
+}
+
+/**
+ * @brief Główna funkcja generatora korpusu.
+ * @param argc Liczba argumentów linii poleceń.
+ * @param argv Katalog wyjściowy, liczba obrazów i opcje.
+ * @return Kod zakończenia (0 = sukces, 1 = błąd).
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Uzycie: " << argv[0] << " katalog liczba [--res uniform:64-512] [--formats png,jpg,bmp] [--seed 1] [--threads 0]\n"
+                  << "  --res: fixed:WxH | uniform:MIN-MAX | lognormal:MEDIANA (dluzszy bok)\n";
+        return 1;
+    }
+    fs::path out_dir = argv[1];
+    // Tylko liczba całkowita: atoll zamieniłby "1e6" lub "1M" na 1
+    char* count_end = nullptr;
+    long long count = std::strtoll(argv[2], &count_end, 10);
+    if (count_end == argv[2] || *count_end != '\0' || count <= 0) {
+        std::cerr << "Nieprawidlowa liczba obrazow: " << argv[2] << "\n";
+        return 1;
+    }
+    ResolutionSpec spec;
+    std::vector<std::string> formats = { "png" };
+    uint64_t seed = 1;
+    unsigned int thread_count = 0;
+
+    for (int i = 3; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            std::cerr << "Nieprawidlowa opcja bez wartosci: " << argv[i] << "\n";
+            return 1;
+        }
+        std::string opt = argv[i], value = argv[i + 1];
+        if (opt == "--res") {
+            if (!parse_resolution(value, spec)) {
+                std::cerr << "Nieprawidlowy rozklad rozmiarow: " << value << "\n";
+                return 1;
+            }
+        } else if (opt == "--formats") {
+            formats.clear();
+            std::stringstream ss(value);
+            std::string ext;
+            while (std::getline(ss, ext, ',')) {
+                if (ext != "png" && ext != "jpg" && ext != "bmp") {
+                    std::cerr << "Nieprawidlowy format (png, jpg, bmp): " << ext << "\n";
+                    return 1;
+                }
+                formats.push_back(ext);
+            }
+        } else if (opt == "--seed") {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (opt == "--threads") {
+            thread_count = static_cast<unsigned int>(std::max(0, std::atoi(value.c_str())));
+        } else {
+            std::cerr << "Nieznana opcja: " << opt << "\n";
+            return 1;
+        }
+    }
+    if (formats.empty()) {
+        std::cerr << "Nieprawidlowa lista formatow\n";
+        return 1;
+    }
+    fs::create_directories(out_dir);
+
+    std::atomic<long long> next_image(0), written(0);
+    unsigned int max_t = std::thread::hardware_concurrency();
+    unsigned int limit = thread_count ? thread_count : (max_t ? max_t : 4);
+    std::vector<std::thread> threads;
+    for (unsigned int w = 0; w < limit; ++w) {
+        threads.emplace_back([&]() {
+            for (long long i = next_image++; i < count; i = next_image++) {
+                // Każdy obraz ma własne ziarno, więc korpus nie zależy od liczby wątków
+                cv::RNG rng(seed * 0x9E3779B97F4A7C15ull + static_cast<uint64_t>(i));
+                const std::string& ext = formats[static_cast<size_t>(i) % formats.size()];
+                char name[32];
+                std::snprintf(name, sizeof(name), "img%07lld.%s", i, ext.c_str());
+                cv::Mat img = synthesize_image(random_size(spec, rng), rng);
+                if (cv::imwrite((out_dir / name).string(), img)) written++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << "Wygenerowano " << written.load() << " obrazow w " << out_dir.string() << "\n";
+    return written.load() == count ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Pomiar skalowania pos_projekt na syntetycznych korpusach.
+
+Dla każdej liczby obrazów generuje korpus (pos_gen_corpus), a następnie
+uruchamia pos_projekt dla kolejnych liczb wątków. Zapisuje przepustowość,
+czas, szczytowe RSS i percentyle latencji pojedynczego obrazu do CSV i JSON.
+Korzysta wyłącznie z biblioteki standardowej i danych generowanych lokalnie.
+
+Przykład:
+    python3 tools/scaling_harness.py --exe build/pos_projekt \\
+        --generator build/pos_gen_corpus --counts 1000,10000 --threads 1,2,4,8
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+
+def parse_list(text):
+    return [int(x) for x in text.split(",") if x.strip()]
+
+
+def percentile(values, p):
+    if not values:
+        return None
+    values = sorted(values)
+    k = (len(values) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(values) - 1)
+    return values[lo] + (values[hi] - values[lo]) * (k - lo)
+
+
+def ensure_corpus(args, count):
+    """Generuje korpus raz i używa go ponownie w kolejnych przebiegach."""
+    name = "corpus_{}_{}_{}_{}".format(
+        count, re.sub(r"[^0-9A-Za-z]+", "_", args.res), args.formats.replace(",", "_"), args.seed)
+    corpus = Path(args.work_dir) / name
+    marker = corpus / ".complete"
+    if marker.exists():
+        return corpus
+    if corpus.exists():
+        shutil.rmtree(corpus)
+    cmd = [args.generator, str(corpus), str(count), "--res", args.res,
+           "--formats", args.formats, "--seed", str(args.seed)]
+    print("Generowanie:", " ".join(cmd), flush=True)
+    subprocess.run(cmd, check=True)
+    marker.touch()
+    return corpus
+
+
+def write_config(path, input_dir, output_dir, threads, opencv_threads, latency_file, thumb_sizes, mosaic, affinity, numa):
+    with open(path, "w") as f:
+        f.write("[Paths]\n")
+        f.write("input_dir={}\n".format(Path(input_dir).resolve().as_posix()))
+        f.write("output_dir={}\n".format(Path(output_dir).resolve().as_posix()))
+        f.write("\n[Thumbnails]\nsizes={}\nmosaic={}\n".format(thumb_sizes, 1 if mosaic else 0))
+        f.write("\n[Threads]\ncount={}\nopencv_threads={}\naffinity={}\nnuma={}\n".format(
+            threads, opencv_threads, affinity, numa))
+        f.write("\n[Stats]\nlatency_file={}\n".format(Path(latency_file).resolve().as_posix()))
+
+
+def windows_peak_rss_mb(proc):
+    """PeakWorkingSetSize zakończonego procesu (uchwyt Popen pozostaje otwarty po wait())."""
+    import ctypes
+    from ctypes import wintypes
+
+    class PROCESS_MEMORY_COUNTERS(ctypes.Structure):
+        _fields_ = [("cb", wintypes.DWORD),
+                    ("PageFaultCount", wintypes.DWORD),
+                    ("PeakWorkingSetSize", ctypes.c_size_t),
+                    ("WorkingSetSize", ctypes.c_size_t),
+                    ("QuotaPeakPagedPoolUsage", ctypes.c_size_t),
+                    ("QuotaPagedPoolUsage", ctypes.c_size_t),
+                    ("QuotaPeakNonPagedPoolUsage", ctypes.c_size_t),
+                    ("QuotaNonPagedPoolUsage", ctypes.c_size_t),
+                    ("PagefileUsage", ctypes.c_size_t),
+                    ("PeakPagefileUsage", ctypes.c_size_t)]
+
+    counters = PROCESS_MEMORY_COUNTERS()
+    counters.cb = ctypes.sizeof(counters)
+    get_info = ctypes.windll.psapi.GetProcessMemoryInfo
+    get_info.argtypes = [wintypes.HANDLE, ctypes.POINTER(PROCESS_MEMORY_COUNTERS), wintypes.DWORD]
+    get_info.restype = wintypes.BOOL
+    if not get_info(wintypes.HANDLE(int(proc._handle)), ctypes.byref(counters), counters.cb):
+        return None
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0)
+
+
+def run_once(exe, config, log_dir):
+    """Uruchamia program i zwraca (czas, stdout, szczytowe RSS w MB lub None)."""
+    # Wyjście trafia do plików, aby pełny potok nie blokował procesu w trakcie wait4
+    stdout_path, stderr_path = Path(log_dir) / "stdout.txt", Path(log_dir) / "stderr.txt"
+    with open(stdout_path, "w") as out, open(stderr_path, "w") as err:
+        start = time.perf_counter()
+        proc = subprocess.Popen([exe, str(config)], stdout=out, stderr=err)
+        if hasattr(os, "wait4"):
+            # wait4 zwraca rusage tylko tego procesu (RUSAGE_CHILDREN kumuluje maksimum)
+            _, status, usage = os.wait4(proc.pid, 0)
+            wall = time.perf_counter() - start
+            returncode = os.waitstatus_to_exitcode(status)
+            scale = 1024.0 * 1024.0 if sys.platform == "darwin" else 1024.0
+            rss_mb = usage.ru_maxrss / scale
+        elif sys.platform == "win32":
+            returncode = proc.wait()
+            wall = time.perf_counter() - start
+            rss_mb = windows_peak_rss_mb(proc)
+        else:
+            returncode = proc.wait()
+            wall = time.perf_counter() - start
+            rss_mb = None
+    if returncode != 0:
+        raise RuntimeError("pos_projekt zakonczyl sie kodem {}:\n{}".format(returncode, stderr_path.read_text()))
+    return wall, stdout_path.read_text(), rss_mb
+
+
+def rounded(value, digits=3):
+    return round(value, digits) if value is not None else None
+
+
+def read_latencies_ms(path):
+    with open(path, newline="") as f:
+        reader = csv.reader(f)
+        next(reader, None)
+        return [float(row[1]) / 1000.0 for row in reader if len(row) >= 2]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--exe", required=True, help="sciezka do pos_projekt")
+    parser.add_argument("--generator", required=True, help="sciezka do pos_gen_corpus")
+    parser.add_argument("--work-dir", default="scaling_work", help="katalog na korpusy i wyniki posrednie")
+    parser.add_argument("--counts", default="1000,10000", help="liczby obrazow, np. 1000,100000,1000000")
+    parser.add_argument("--threads", default="1,2,4,8", help="liczby watkow")
+    parser.add_argument("--res", default="uniform:64-512", help="rozklad rozmiarow (jak w pos_gen_corpus)")
+    parser.add_argument("--formats", default="png", help="formaty, np. png,jpg,bmp")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--opencv-threads", type=int, default=1,
+                        help="[Threads] opencv_threads; 1 = rownoleglosc tylko z watkow roboczych, "
+                             "wiec przebieg threads=1 jest jednowatkowy")
+    parser.add_argument("--thumb-sizes", default="64,128,256", help="[Thumbnails] sizes")
+    parser.add_argument("--mosaic", action="store_true",
+                        help="zapisuj mozaiki (przechowuje wszystkie miniaturki w pamieci; "
+                             "RSS i czas przestaja mierzyc sam potok obrazow)")
+    parser.add_argument("--affinity", default="none", help="[Threads] affinity")
+    parser.add_argument("--numa", default="off", help="[Threads] numa")
+    parser.add_argument("--repeat", type=int, default=1, help="liczba powtorzen kazdego pomiaru")
+    parser.add_argument("--out", default="scaling", help="prefiks plikow wynikowych (.csv i .json)")
+    args = parser.parse_args()
+
+    work = Path(args.work_dir)
+    work.mkdir(parents=True, exist_ok=True)
+    runs = []
+    for count in parse_list(args.counts):
+        corpus = ensure_corpus(args, count)
+        baseline = None
+        for threads in parse_list(args.threads):
+            for rep in range(args.repeat):
+                out_dir = work / "out"
+                if out_dir.exists():
+                    shutil.rmtree(out_dir)
+                config = work / "config.ini"
+                latency_file = work / "latency.csv"
+                write_config(config, corpus, out_dir, threads, args.opencv_threads, latency_file,
+                             args.thumb_sizes, args.mosaic, args.affinity, args.numa)
+                wall, stdout, rss_mb = run_once(args.exe, config, work)
+
+                match = re.search(r"Przetworzono (\d+)", stdout)
+                processed = int(match.group(1)) if match else 0
+                lat = read_latencies_ms(latency_file)
+                throughput = processed / wall if wall > 0 else 0.0
+                if baseline is None:
+                    baseline = (threads, throughput)
+                speedup = throughput / baseline[1] if baseline[1] else None
+                run = {
+                    "images": count,
+                    "threads": threads,
+                    "opencv_threads": args.opencv_threads,
+                    "repeat": rep,
+                    "processed": processed,
+                    "wall_s": round(wall, 4),
+                    "throughput_img_s": round(throughput, 2),
+                    "peak_rss_mb": round(rss_mb, 1) if rss_mb is not None else None,
+                    "lat_p50_ms": rounded(percentile(lat, 50)),
+                    "lat_p95_ms": rounded(percentile(lat, 95)),
+                    "lat_p99_ms": rounded(percentile(lat, 99)),
+                    "lat_max_ms": rounded(max(lat)) if lat else None,
+                    "speedup": round(speedup, 3) if speedup is not None else None,
+                    "efficiency": round(speedup * baseline[0] / threads, 3) if speedup is not None else None,
+                }
+                runs.append(run)
+                print("obrazy={images} watki={threads} czas={wall_s}s przepustowosc={throughput_img_s}/s "
+                      "rss={peak_rss_mb}MB p99={lat_p99_ms}ms".format(**run), flush=True)
+
+    fields = list(runs[0].keys()) if runs else []
+    with open(args.out + ".csv", "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(runs)
+    with open(args.out + ".json", "w") as f:
+        json.dump({"config": vars(args), "runs": runs}, f, indent=2)
+    print("Wyniki zapisano w {0}.csv i {0}.json".format(args.out))
+
+
+if __name__ == "__main__":
+    main()